@@ -124,27 +124,10 @@ error:
   return ret;
 }
 
-char *cmd_up(void *self, char *argv[], int argc) {
-  co_cmd_t *this = self;
-  unsigned char mac[6];
-  memset(mac, '\0', sizeof(mac));
+static int _cmd_up_apply(co_iface_t *iface, co_profile_t *prof) {
+#ifndef _OPENWRT
   char address[16];
   memset(address, '\0', sizeof(address));
-  char *ret;
-  if(argc < 2) {
-    return this->usage;
-  }
-  co_iface_t *iface = co_iface_add(argv[0], AF_INET);
-  DEBUG("Bringing up iface %s", argv[0]);
-  CHECK(iface != NULL, "Failed to create interface %s.", argv[0]);
-  nodeid_t id = co_id_get();
-  if(!id.id && co_iface_get_mac(iface, mac)) {
-    //print_mac(mac);
-    co_id_set_from_mac(mac);
-  }
-  co_profile_t *prof = co_profile_find(argv[1]);
-  CHECK(prof != NULL, "Failed to load profile %s.", argv[1]);
-#ifndef _OPENWRT
   co_profile_dump(prof);
   if(!strcmp("true", co_profile_get_string(prof, "ipgenerate", "true"))) {
     co_generate_ip(co_profile_get_string(prof, "ip", "5.0.0.0"), 
@@ -169,12 +152,46 @@ char *cmd_up(void *self, char *argv[], int argc) {
   co_set_dns(co_profile_get_string(prof, "dns", "8.8.8.8"), co_profile_get_string(prof, "domain", "mesh.local"), "/tmp/resolv.commotion");
   co_iface_set_ip(iface, address, co_profile_get_string(prof, "netmask", "255.0.0.0"));
 #endif
+  return 1;
+}
+
+int co_cmd_iface_reapply(co_iface_t *iface) {
+  co_profile_t *prof = NULL;
+  CHECK_MEM(iface);
+  CHECK((prof = co_profile_find(iface->profile)) != NULL, "Failed to load profile %s.", iface->profile);
+  if(iface->wireless) co_iface_wpa_disconnect(iface);
+  iface->wpa_id = -1;
+  return _cmd_up_apply(iface, prof);
+
+error:
+  return 0;
+}
+
+char *cmd_up(void *self, char *argv[], int argc) {
+  co_cmd_t *this = self;
+  unsigned char mac[6];
+  memset(mac, '\0', sizeof(mac));
+  char *ret;
+  if(argc < 2) {
+    return this->usage;
+  }
+  co_iface_t *iface = co_iface_add(argv[0], AF_INET);
+  DEBUG("Bringing up iface %s", argv[0]);
+  CHECK(iface != NULL, "Failed to create interface %s.", argv[0]);
+  nodeid_t id = co_id_get();
+  if(!id.id && co_iface_get_mac(iface, mac)) {
+    //print_mac(mac);
+    co_id_set_from_mac(mac);
+  }
+  co_profile_t *prof = co_profile_find(argv[1]);
+  CHECK(prof != NULL, "Failed to load profile %s.", argv[1]);
+  _cmd_up_apply(iface, prof);
+  free(iface->profile);
   iface->profile = strdup(argv[1]);
 
   ret = strdup("Interface up.\n");
   return ret;
 error:
-  free(iface);
   ret = strdup("Interface up failed.\n");
   return ret;
 }
@@ -219,6 +236,12 @@ char *cmd_state(void *self, char *argv[], int argc) {
   if(argc < 2) {
     return ret = strdup(this->usage);
   }
+  if(!strcmp(argv[1], "link")) {
+    co_iface_t *iface = NULL;
+    CHECK((iface = co_iface_get(argv[0])), "Interface state is inactive.");
+    if(!iface->present) return ret = strdup("absent\n");
+    return ret = strdup(iface->status == UP ? "up\n" : "down\n");
+  }
   char *profile_name = NULL; 
   CHECK((profile_name = co_iface_profile(argv[0])), "Interface state is inactive."); 
   DEBUG("profile_name: %s", profile_name);
@@ -34,6 +34,7 @@
 #define _COMMAND_H
 
 #include <stdlib.h>
+#include "iface.h"
 #define MAX_COMMANDS 32
 
 
@@ -55,6 +56,8 @@ char *co_cmd_usage(char *name, int mask);
 
 char *co_cmd_description(char *name, int mask);
 
+int co_cmd_iface_reapply(co_iface_t *iface);
+
 char *cmd_help(void *self, char *argv[], int argc);
 
 char *cmd_list_profiles(void *self, char *argv[], int argc);
@@ -0,0 +1,13 @@
+#ifndef _CONFIG_H
+#define _CONFIG_H
+
+#define COMMOTION_VERSION_MAJOR 0
+#define COMMOTION_VERSION_MINOR 1
+#define COMMOTION_VERSION_PATCH 0
+#define COMMOTION_STATEDIR "/var/run/commotion"
+#define COMMOTION_PIDFILE "/var/run/commotiond.pid"
+#define COMMOTION_MANAGESOCK "/var/run/commotiond.sock"
+#define COMMOTION_PLUGINDIR "/usr/lib/commotion/plugins"
+#define COMMOTION_PROFILEDIR "/etc/commotion/profiles.d"
+
+#endif
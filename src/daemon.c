@@ -47,12 +47,14 @@
 #include "process.h"
 #include "profile.h"
 #include "socket.h"
+#include "netlink.h"
 #include "msg.h"
 #include "olsrd.h"
 #include "iface.h"
 #include "id.h"
 
 extern co_socket_t unix_socket_proto;
+extern co_socket_t netlink_socket_proto;
 static int pid_filehandle;
 
 int dispatcher_cb(void *self, void *context);
@@ -168,6 +170,7 @@ static void print_usage() {
           " -i, --id <nodeid>     Specify unique id number for this node.\n"
           " -n, --nodaemonize     Do not fork into the background.\n"
           " -p, --pid <file>      Specify pid file.\n"
+          " -r, --reapply         Re-apply profiles to interfaces that return.\n"
           " -s, --statedir <dir>  Specify instance directory.\n"
           " -h, --help            Print this usage message.\n"
   );
@@ -178,13 +181,14 @@ int main(int argc, char *argv[]) {
   int opt_index = 0;
   int daemonize = 1;
   int newid = 0;
+  int reapply = 0;
   char *pidfile = COMMOTION_PIDFILE;
   char *statedir = COMMOTION_STATEDIR;
   char *socket_uri = COMMOTION_MANAGESOCK;
   //char *plugindir = COMMOTION_PLUGINDIR;
   char *profiledir = COMMOTION_PROFILEDIR;
 
-  static const char *opt_string = "b:d:f:i:np:s:h";
+  static const char *opt_string = "b:d:f:i:np:rs:h";
 
   static struct option long_opts[] = {
     {"bind", required_argument, NULL, 'b'},
@@ -193,6 +197,7 @@ int main(int argc, char *argv[]) {
     {"nodeid", required_argument, NULL, 'i'},
     {"nodaemon", no_argument, NULL, 'n'},
     {"pid", required_argument, NULL, 'p'},
+    {"reapply", no_argument, NULL, 'r'},
     {"statedir", required_argument, NULL, 's'},
     {"help", no_argument, NULL, 'h'}
   };
@@ -219,6 +224,9 @@ int main(int argc, char *argv[]) {
       case 'p':
         pidfile = optarg;
         break;
+      case 'r':
+        reapply = 1;
+        break;
       case 's':
         statedir = optarg;
         break;
@@ -238,6 +246,11 @@ int main(int argc, char *argv[]) {
   DEBUG("Node ID: %d", (int) id.id);
   co_loop_create();
   co_ifaces_create();
+  co_socket_t *monitor = NEW(co_socket, netlink_socket);
+  monitor->poll_cb = co_iface_monitor_cb;
+  monitor->register_cb = co_loop_add_socket;
+  monitor->bind(monitor, NETLINK_MONITOR);
+  co_iface_monitor(monitor, reapply ? co_cmd_iface_reapply : NULL);
   co_profiles_create();
   co_profile_import_files(profiledir);
   co_cmd_add("help", cmd_help, "help <none>\n", "Print list of commands and usage information.\n", 0);
@@ -0,0 +1,179 @@
+/* vim: set ts=2 expandtab: */
+/**
+ *       @file  hash.c
+ *      @brief  a simple chained hash table keyed by arbitrary bytes
+ *
+ *     @author  Josh King (jheretic), jking@chambana.net
+ *
+ *   @internal
+ *     Created  03/07/2013
+ *    Revision  $Id: doxygen.commotion.templates,v 0.1 2013/01/01 09:00:00 jheretic Exp $
+ *    Compiler  gcc/g++
+ *     Company  The Open Technology Institute
+ *   Copyright  Copyright (c) 2013, Josh King
+ *
+ * This file is part of Commotion, Copyright (c) 2013, Josh King 
+ * 
+ * Commotion is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, 
+ * or (at your option) any later version.
+ * 
+ * Commotion is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Commotion.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "debug.h"
+#include "hash.h"
+
+static co_hash_entry_t **_co_hash_find(const co_hash_t *hash, const void *key, const size_t keylen, const uint32_t h) {
+  co_hash_entry_t **entry = &hash->buckets[h & (hash->size - 1)];
+  while(*entry) {
+    if((*entry)->hash == h && (*entry)->keylen == keylen && !memcmp((*entry)->key, key, keylen)) break;
+    entry = &(*entry)->next;
+  }
+  return entry;
+}
+
+static int _co_hash_resize(co_hash_t *hash, const size_t size) {
+  co_hash_entry_t **buckets = calloc(size, sizeof(co_hash_entry_t *));
+  CHECK_MEM(buckets);
+  for(size_t i = 0; i < hash->size; i++) {
+    co_hash_entry_t *entry = hash->buckets[i];
+    while(entry) {
+      co_hash_entry_t *next = entry->next;
+      entry->next = buckets[entry->hash & (size - 1)];
+      buckets[entry->hash & (size - 1)] = entry;
+      entry = next;
+    }
+  }
+  free(hash->buckets);
+  hash->buckets = buckets;
+  hash->size = size;
+  return 1;
+
+error:
+  return 0;
+}
+
+uint32_t co_hash_fnv1a(const void *data, const size_t len) {
+  const unsigned char *bytes = data;
+  uint32_t h = 2166136261U;
+  for(size_t i = 0; i < len; i++) {
+    h ^= bytes[i];
+    h *= 16777619U;
+  }
+  return h;
+}
+
+uint64_t co_hash_fnv1a64(const void *data, const size_t len) {
+  const unsigned char *bytes = data;
+  uint64_t h = 14695981039346656037ULL;
+  for(size_t i = 0; i < len; i++) {
+    h ^= bytes[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+co_hash_t *co_hash_create(const size_t size) {
+  co_hash_t *hash = malloc(sizeof(co_hash_t));
+  CHECK_MEM(hash);
+  hash->size = HASH_DEFAULT_SIZE;
+  //Bucket count is kept to a power of two so it can be masked.
+  while(hash->size < size) hash->size <<= 1;
+  hash->count = 0;
+  hash->buckets = calloc(hash->size, sizeof(co_hash_entry_t *));
+  CHECK_MEM(hash->buckets);
+  return hash;
+
+error:
+  free(hash);
+  return NULL;
+}
+
+void co_hash_destroy(co_hash_t *hash) {
+  if(hash == NULL) return;
+  for(size_t i = 0; i < hash->size; i++) {
+    co_hash_entry_t *entry = hash->buckets[i];
+    while(entry) {
+      co_hash_entry_t *next = entry->next;
+      free(entry);
+      entry = next;
+    }
+  }
+  free(hash->buckets);
+  free(hash);
+  return;
+}
+
+int co_hash_insert(co_hash_t *hash, const void *key, const size_t keylen, void *value) {
+  CHECK_MEM(hash);
+  uint32_t h = co_hash_fnv1a(key, keylen);
+  co_hash_entry_t **entry = _co_hash_find(hash, key, keylen, h);
+
+  if(*entry) {
+    (*entry)->value = value;
+    return 1;
+  }
+
+  co_hash_entry_t *new_entry = malloc(sizeof(co_hash_entry_t) + keylen);
+  CHECK_MEM(new_entry);
+  new_entry->next = NULL;
+  new_entry->hash = h;
+  new_entry->keylen = keylen;
+  new_entry->value = value;
+  memmove(new_entry->key, key, keylen);
+  *entry = new_entry;
+  hash->count++;
+
+  if(hash->count > hash->size - (hash->size >> 2)) _co_hash_resize(hash, hash->size << 1);
+  return 1;
+
+error:
+  return 0;
+}
+
+void *co_hash_get(const co_hash_t *hash, const void *key, const size_t keylen) {
+  if(hash == NULL) return NULL;
+  co_hash_entry_t **entry = _co_hash_find(hash, key, keylen, co_hash_fnv1a(key, keylen));
+  return *entry ? (*entry)->value : NULL;
+}
+
+void *co_hash_remove(co_hash_t *hash, const void *key, const size_t keylen) {
+  if(hash == NULL) return NULL;
+  co_hash_entry_t **entry = _co_hash_find(hash, key, keylen, co_hash_fnv1a(key, keylen));
+  co_hash_entry_t *old = *entry;
+  void *value = NULL;
+  if(old == NULL) return NULL;
+  *entry = old->next;
+  value = old->value;
+  free(old);
+  hash->count--;
+  return value;
+}
+
+void co_hash_process(co_hash_t *hash, void *context, co_hash_iter_t function) {
+  if(hash == NULL) return;
+  for(size_t i = 0; i < hash->size; i++) {
+    co_hash_entry_t *entry = hash->buckets[i];
+    while(entry) {
+      //Callbacks may remove the current entry, but must not insert.
+      co_hash_entry_t *next = entry->next;
+      function(entry->key, entry->keylen, entry->value, context);
+      entry = next;
+    }
+  }
+  return;
+}
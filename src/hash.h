@@ -0,0 +1,76 @@
+/* vim: set ts=2 expandtab: */
+/**
+ *       @file  hash.h
+ *      @brief  a simple chained hash table keyed by arbitrary bytes
+ *
+ *     @author  Josh King (jheretic), jking@chambana.net
+ *
+ *   @internal
+ *     Created  03/07/2013
+ *    Revision  $Id: doxygen.commotion.templates,v 0.1 2013/01/01 09:00:00 jheretic Exp $
+ *    Compiler  gcc/g++
+ *     Company  The Open Technology Institute
+ *   Copyright  Copyright (c) 2013, Josh King
+ *
+ * This file is part of Commotion, Copyright (c) 2013, Josh King 
+ * 
+ * Commotion is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, 
+ * or (at your option) any later version.
+ * 
+ * Commotion is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Commotion.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =====================================================================================
+ */
+
+#ifndef _HASH_H
+#define _HASH_H
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASH_DEFAULT_SIZE 16
+
+typedef struct co_hash_entry_t {
+  struct co_hash_entry_t *next;
+  uint32_t hash;
+  size_t keylen;
+  void *value;
+  char key[];
+} co_hash_entry_t;
+
+typedef struct {
+  co_hash_entry_t **buckets;
+  size_t size;
+  size_t count;
+} co_hash_t;
+
+typedef void (*co_hash_iter_t)(const void *key, const size_t keylen, void *value, void *context);
+
+uint32_t co_hash_fnv1a(const void *data, const size_t len);
+
+uint64_t co_hash_fnv1a64(const void *data, const size_t len);
+
+co_hash_t *co_hash_create(const size_t size);
+
+void co_hash_destroy(co_hash_t *hash);
+
+int co_hash_insert(co_hash_t *hash, const void *key, const size_t keylen, void *value);
+
+void *co_hash_get(const co_hash_t *hash, const void *key, const size_t keylen);
+
+void *co_hash_remove(co_hash_t *hash, const void *key, const size_t keylen);
+
+void co_hash_process(co_hash_t *hash, void *context, co_hash_iter_t function);
+
+#define co_hash_count(H) ((H)->count)
+
+#endif
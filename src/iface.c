@@ -33,6 +33,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <ifaddrs.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -42,18 +44,26 @@
 #include <netinet/in.h>
 #include <linux/sockios.h>
 #include "extern/wpa_ctrl.h"
-#include "extern/list.h"
 #include "debug.h"
+#include "hash.h"
+#include "socket.h"
+#include "netlink.h"
 #include "iface.h"
 #include "util.h"
 #include "id.h"
 
 
-static list_t *ifaces = NULL;
+static co_hash_t *ifaces = NULL;
+static co_hash_t *ifaces_by_index = NULL;
+static int iface_fd = -1;
 static char *wpa_control_dir = "/var/run/wpa_supplicant";
+static co_socket_t *monitor = NULL;
+static co_iface_reapply_t reapply_handler = NULL;
+static bool monitor_dump_addrs = false;
 
 static int _co_iface_is_wireless(const co_iface_t *iface) {
-	CHECK((ioctl(iface->fd, SIOCGIWNAME, iface->ifr) != -1), "No wireless extensions for interface: %s", iface->ifr.ifr_name);
+  struct ifreq ifr = iface->ifr;
+	CHECK((ioctl(iface_fd, SIOCGIWNAME, &ifr) != -1), "No wireless extensions for interface: %s", iface->ifr.ifr_name);
   return 1;
 error: 
   return 0;
@@ -126,28 +136,234 @@ error:
   return 0;
 }
 
-static int _co_iface_match_i(const void *iface, const void *iface_name) {
-  const co_iface_t *this_iface = iface;
-  const char *this_name = iface_name;
-  if((strcmp(this_iface->ifr.ifr_name, this_name)) == 0) return 0;
-  return -1;
+static void _co_iface_set_index(co_iface_t *iface, const int index) {
+  if(iface->index > 0) co_hash_remove(ifaces_by_index, &iface->index, sizeof(iface->index));
+  iface->index = index;
+  if(iface->index > 0) co_hash_insert(ifaces_by_index, &iface->index, sizeof(iface->index), iface);
+  return;
+}
+
+static size_t _co_iface_addr_size(const int family) {
+  if(family == AF_INET) return sizeof(struct in_addr);
+  if(family == AF_INET6) return sizeof(struct in6_addr);
+  return 0;
+}
+
+static void _co_iface_addr_update(co_iface_t *iface, const co_iface_addr_t *addr, const bool add) {
+  size_t size = _co_iface_addr_size(addr->family);
+  int i;
+  for(i = 0; i < iface->naddrs; i++) {
+    if(iface->addrs[i].family == addr->family && !memcmp(&iface->addrs[i].addr, &addr->addr, size)) break;
+  }
+
+  if(add) {
+    if(i == iface->naddrs) {
+      CHECK(iface->naddrs < IFACE_ADDRS_MAX, "Too many addresses on interface %s.", iface->ifr.ifr_name);
+      iface->naddrs++;
+    }
+    iface->addrs[i] = *addr;
+  } else if(i < iface->naddrs) {
+    iface->addrs[i] = iface->addrs[--iface->naddrs];
+  }
+
+error:
+  return;
+}
+
+static void _co_iface_set_flags(co_iface_t *iface, const unsigned int flags) {
+  co_iface_status_t status = ((flags & IFF_UP) && (flags & IFF_RUNNING)) ? UP : DOWN;
+  iface->flags = flags;
+  if(status == iface->status) return;
+  iface->status = status;
+  INFO("Interface %s is now %s.", iface->ifr.ifr_name, status == UP ? "up" : "down");
+
+  /* 
+   * Only re-apply profiles to interfaces that
+   * were lost after being brought up, not to
+   * ones coming up for the first time.
+   */
+  if(status == DOWN && iface->profile) {
+    iface->lost = true;
+  } else if(status == UP && iface->lost) {
+    iface->lost = false;
+    if(reapply_handler) {
+      INFO("Re-applying profile %s to interface %s.", iface->profile, iface->ifr.ifr_name);
+      reapply_handler(iface);
+    }
+  }
+  return;
+}
+
+static void _co_iface_load_state(co_iface_t *iface) {
+  struct ifreq ifr;
+  struct ifaddrs *ifaddr = NULL, *ifa = NULL;
+
+  memset(&ifr, '\0', sizeof(ifr));
+  strlcpy(ifr.ifr_name, iface->ifr.ifr_name, IFNAMSIZ);
+  _co_iface_set_index(iface, if_nametoindex(iface->ifr.ifr_name));
+  iface->present = (iface->index > 0);
+  if(ioctl(iface_fd, SIOCGIFFLAGS, &ifr) == 0) _co_iface_set_flags(iface, ifr.ifr_flags);
+
+  CHECK(getifaddrs(&ifaddr) != -1, "Failed to get addresses for interface %s.", iface->ifr.ifr_name);
+  for(ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next) {
+    if(ifa->ifa_addr == NULL || strcmp(ifa->ifa_name, iface->ifr.ifr_name)) continue;
+    co_iface_addr_t addr;
+    memset(&addr, '\0', sizeof(addr));
+    addr.family = ifa->ifa_addr->sa_family;
+    if(addr.family == AF_INET) {
+      addr.addr.v4 = ((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
+      if(ifa->ifa_netmask) addr.prefixlen = __builtin_popcount(((struct sockaddr_in *)ifa->ifa_netmask)->sin_addr.s_addr);
+    } else if(addr.family == AF_INET6) {
+      addr.addr.v6 = ((struct sockaddr_in6 *)ifa->ifa_addr)->sin6_addr;
+      for(int i = 0; ifa->ifa_netmask && i < 16; i++) {
+        addr.prefixlen += __builtin_popcount(((struct sockaddr_in6 *)ifa->ifa_netmask)->sin6_addr.s6_addr[i]);
+      }
+    } else continue;
+    _co_iface_addr_update(iface, &addr, true);
+  }
+
+error:
+  if(ifaddr) freeifaddrs(ifaddr);
+  return;
+}
+
+static void _co_iface_monitor_link(const struct nlmsghdr *nh) {
+  struct ifinfomsg *ifi = NLMSG_DATA(nh);
+  int len = IFLA_PAYLOAD(nh);
+  const char *name = NULL;
+  co_iface_t *iface = NULL;
+
+  for(struct rtattr *rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if(rta->rta_type == IFLA_IFNAME) name = RTA_DATA(rta);
+  }
+
+  //Interfaces that vanished and came back get a new index, so fall back to the name.
+  if(!(iface = co_hash_get(ifaces_by_index, &ifi->ifi_index, sizeof(ifi->ifi_index))) && name) {
+    iface = co_hash_get(ifaces, name, strlen(name));
+  }
+  if(iface == NULL) return;
+
+  if(nh->nlmsg_type == RTM_DELLINK) {
+    if(iface->index != ifi->ifi_index) return;
+    INFO("Interface %s was removed.", iface->ifr.ifr_name);
+    _co_iface_set_flags(iface, 0);
+    _co_iface_set_index(iface, 0);
+    iface->present = false;
+    iface->naddrs = 0;
+    return;
+  }
+
+  if(name && strcmp(name, iface->ifr.ifr_name)) {
+    INFO("Interface %s was renamed to %s.", iface->ifr.ifr_name, name);
+    co_hash_remove(ifaces, iface->ifr.ifr_name, strlen(iface->ifr.ifr_name));
+    strlcpy(iface->ifr.ifr_name, name, IFNAMSIZ);
+    co_hash_insert(ifaces, iface->ifr.ifr_name, strlen(iface->ifr.ifr_name), iface);
+  }
+  if(iface->index != ifi->ifi_index) _co_iface_set_index(iface, ifi->ifi_index);
+  iface->present = true;
+  _co_iface_set_flags(iface, ifi->ifi_flags);
+  return;
+}
+
+static void _co_iface_monitor_addr(const struct nlmsghdr *nh) {
+  struct ifaddrmsg *ifa = NLMSG_DATA(nh);
+  int len = IFA_PAYLOAD(nh);
+  int index = ifa->ifa_index;
+  const void *data = NULL;
+  co_iface_t *iface = NULL;
+  co_iface_addr_t addr;
+  size_t size = _co_iface_addr_size(ifa->ifa_family);
+
+  if(size == 0 || !(iface = co_hash_get(ifaces_by_index, &index, sizeof(index)))) return;
+
+  //IFA_LOCAL is the interface's own address on point-to-point links.
+  for(struct rtattr *rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len)) {
+    if(rta->rta_type == IFA_LOCAL) data = RTA_DATA(rta);
+    else if(rta->rta_type == IFA_ADDRESS && data == NULL) data = RTA_DATA(rta);
+  }
+  if(data == NULL) return;
+
+  memset(&addr, '\0', sizeof(addr));
+  addr.family = ifa->ifa_family;
+  addr.prefixlen = ifa->ifa_prefixlen;
+  memmove(&addr.addr, data, size);
+  _co_iface_addr_update(iface, &addr, nh->nlmsg_type == RTM_NEWADDR);
+  return;
+}
+
+static void _co_iface_clear_addrs_i(const void *key, const size_t keylen, void *value, void *context) {
+  co_iface_t *iface = value;
+  iface->naddrs = 0;
+  return;
+}
+
+int co_iface_monitor(void *sock, co_iface_reapply_t reapply) {
+  CHECK_MEM(sock);
+  monitor = sock;
+  reapply_handler = reapply;
+  return 1;
+
+error:
+  return 0;
+}
+
+int co_iface_monitor_cb(void *self, void *context) {
+  co_socket_t *sock = self;
+  char buffer[NETLINK_BUFSIZE] __attribute__((aligned(NLMSG_ALIGNTO)));
+  int received = 0;
+
+  while((received = sock->receive(sock, buffer, sizeof(buffer))) >= 0) {
+    for(struct nlmsghdr *nh = (struct nlmsghdr *)buffer; NLMSG_OK(nh, received); nh = NLMSG_NEXT(nh, received)) {
+      switch(nh->nlmsg_type) {
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+          _co_iface_monitor_link(nh);
+          break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+          _co_iface_monitor_addr(nh);
+          break;
+        case NLMSG_DONE:
+          //Links are dumped first, then addresses.
+          if(monitor_dump_addrs) {
+            monitor_dump_addrs = false;
+            co_hash_process(ifaces, NULL, _co_iface_clear_addrs_i);
+            co_netlink_request_dump(sock, RTM_GETADDR, AF_UNSPEC);
+          }
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  //The kernel dropped events, so re-read everything.
+  if(errno == ENOBUFS) {
+    WARN("Netlink monitor overrun, resynchronizing interfaces.");
+    monitor_dump_addrs = true;
+    co_netlink_request_dump(sock, RTM_GETLINK, AF_UNSPEC);
+  }
+  errno = 0;
+  return 1;
 }
 
 int co_ifaces_create(void) {
-  CHECK((ifaces = list_create(IFACES_MAX)) != NULL, "Interface loader creation failed, clearing lists.");
+  CHECK((ifaces = co_hash_create(HASH_DEFAULT_SIZE)) != NULL, "Interface loader creation failed, clearing tables.");
+  CHECK((ifaces_by_index = co_hash_create(HASH_DEFAULT_SIZE)) != NULL, "Interface loader creation failed, clearing tables.");
+  CHECK((iface_fd = socket(PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_IP)) != -1, "Failed to open interface control socket.");
   return 1;
 
 error:
-  list_destroy(ifaces);
-  free(ifaces);
+  co_hash_destroy(ifaces);
+  co_hash_destroy(ifaces_by_index);
+  ifaces = ifaces_by_index = NULL;
   return 0;
 }
 
 int co_iface_remove(const char *iface_name) {
-  lnode_t *node;
-  CHECK((node = list_find(ifaces, iface_name, _co_iface_match_i)) != NULL, "Failed to delete interface %s!", iface_name);
-  node = list_delete(ifaces, node);
-  co_iface_t *iface = lnode_get(node);
+  co_iface_t *iface = NULL;
+  CHECK((iface = co_hash_remove(ifaces, iface_name, strlen(iface_name))) != NULL, "Failed to delete interface %s!", iface_name);
+  _co_iface_set_index(iface, 0);
   co_iface_unset_ip(iface);
   co_iface_wireless_disable(iface);
   co_iface_wpa_disconnect(iface);
@@ -160,9 +376,10 @@ error:
 }
 
 co_iface_t *co_iface_add(const char *iface_name, const int family) {
-  co_iface_t *iface = malloc(sizeof(co_iface_t));
+  co_iface_t *iface = NULL;
+  if((iface = co_hash_get(ifaces, iface_name, strlen(iface_name)))) return iface;
+  iface = malloc(sizeof(co_iface_t));
   memset(iface, '\0', sizeof(co_iface_t));
-  iface->fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_IP);
   strlcpy(iface->ifr.ifr_name, iface_name, IFNAMSIZ);
   
   if((family & AF_INET) == AF_INET) {
@@ -177,24 +394,21 @@ co_iface_t *co_iface_add(const char *iface_name, const int family) {
 
   if(_co_iface_is_wireless(iface)) iface->wireless = true;
   iface->wpa_id = -1;
+  _co_iface_load_state(iface);
     
-  list_append(ifaces, lnode_create((void *)iface));
+  co_hash_insert(ifaces, iface->ifr.ifr_name, strlen(iface->ifr.ifr_name), iface);
   return iface; 
 }
 
 int co_iface_get_mac(co_iface_t *iface, unsigned char output[6]) {
-  co_iface_t *maciface = malloc(sizeof(co_iface_t));
-  memset(maciface, '\0', sizeof(co_iface_t));
-  memmove(maciface, iface, sizeof(co_iface_t));
-  if (0 == ioctl(iface->fd, SIOCGIFHWADDR, &maciface->ifr)) {
+  struct ifreq ifr = iface->ifr;
+  if (0 == ioctl(iface_fd, SIOCGIFHWADDR, &ifr)) {
     DEBUG("Received MAC Address : %02x:%02x:%02x:%02x:%02x:%02x\n",
-                maciface->ifr.ifr_hwaddr.sa_data[0],maciface->ifr.ifr_hwaddr.sa_data[1],maciface->ifr.ifr_hwaddr.sa_data[2]
-                ,maciface->ifr.ifr_hwaddr.sa_data[3],maciface->ifr.ifr_hwaddr.sa_data[4],maciface->ifr.ifr_hwaddr.sa_data[5]);
-    memmove(output, maciface->ifr.ifr_addr.sa_data, sizeof(output));
-    free(maciface);
+                ifr.ifr_hwaddr.sa_data[0],ifr.ifr_hwaddr.sa_data[1],ifr.ifr_hwaddr.sa_data[2]
+                ,ifr.ifr_hwaddr.sa_data[3],ifr.ifr_hwaddr.sa_data[4],ifr.ifr_hwaddr.sa_data[5]);
+    memmove(output, ifr.ifr_hwaddr.sa_data, MAC_LEN);
     return 1;
   }
-  free(maciface);
   return 0;
 }
 
@@ -207,16 +421,16 @@ int co_iface_set_ip(co_iface_t *iface, const char *ip_addr, const char *netmask)
  
 	// Convert IP from numbers and dots to binary notation
   inet_pton(AF_INET, ip_addr, &addr->sin_addr);
-	CHECK((ioctl(iface->fd, SIOCSIFADDR, &iface->ifr) == 0), "Failed to set IP address for interface: %s", iface->ifr.ifr_name);
+	CHECK((ioctl(iface_fd, SIOCSIFADDR, &iface->ifr) == 0), "Failed to set IP address for interface: %s", iface->ifr.ifr_name);
 
   inet_pton(AF_INET, netmask, &addr->sin_addr);
-	CHECK((ioctl(iface->fd, SIOCSIFNETMASK, &iface->ifr) == 0), "Failed to set IP address for interface: %s", iface->ifr.ifr_name);
+	CHECK((ioctl(iface_fd, SIOCSIFNETMASK, &iface->ifr) == 0), "Failed to set IP address for interface: %s", iface->ifr.ifr_name);
 
   //Get and set interface flags.
-  CHECK((ioctl(iface->fd, SIOCGIFFLAGS, &iface->ifr) == 0), "Interface shutdown: %s", iface->ifr.ifr_name);
+  CHECK((ioctl(iface_fd, SIOCGIFFLAGS, &iface->ifr) == 0), "Interface shutdown: %s", iface->ifr.ifr_name);
 	iface->ifr.ifr_flags |= IFF_UP;
 	iface->ifr.ifr_flags |= IFF_RUNNING;
-	CHECK((ioctl(iface->fd, SIOCSIFFLAGS, &iface->ifr) == 0), "Interface up failed: %s", iface->ifr.ifr_name);
+	CHECK((ioctl(iface_fd, SIOCSIFFLAGS, &iface->ifr) == 0), "Interface up failed: %s", iface->ifr.ifr_name);
  
   DEBUG("Addressing for interface %s is done!", iface->ifr.ifr_name);
 	return 1;
@@ -228,10 +442,10 @@ error:
 int co_iface_unset_ip(co_iface_t *iface) {
   CHECK_MEM(iface); 
   //Get and set interface flags.
-  CHECK((ioctl(iface->fd, SIOCGIFFLAGS, &iface->ifr) == 0), "Interface shutdown: %s", iface->ifr.ifr_name);
+  CHECK((ioctl(iface_fd, SIOCGIFFLAGS, &iface->ifr) == 0), "Interface shutdown: %s", iface->ifr.ifr_name);
 	iface->ifr.ifr_flags &= ~IFF_UP;
 	iface->ifr.ifr_flags &= ~IFF_RUNNING;
-	CHECK((ioctl(iface->fd, SIOCSIFFLAGS, &iface->ifr) == 0), "Interface up failed: %s", iface->ifr.ifr_name);
+	CHECK((ioctl(iface_fd, SIOCSIFFLAGS, &iface->ifr) == 0), "Interface up failed: %s", iface->ifr.ifr_name);
   return 1;
 error:
   return 0;
@@ -419,18 +633,17 @@ error:
 }
 
 char *co_iface_profile(const char *iface_name) {
-  lnode_t *node;
-  CHECK((node = list_find(ifaces, iface_name, _co_iface_match_i)) != NULL, "Failed to get interface %s profile!", iface_name);
-  co_iface_t *iface = lnode_get(node);
+  co_iface_t *iface = NULL;
+  CHECK((iface = co_hash_get(ifaces, iface_name, strlen(iface_name))) != NULL, "Failed to get interface %s profile!", iface_name);
   return iface->profile;
 error:
   return NULL;
 }
 
 co_iface_t *co_iface_get(const char *iface_name) {
-  lnode_t *node;
-  CHECK((node = list_find(ifaces, iface_name, _co_iface_match_i)) != NULL, "Failed to get interface %s profile!", iface_name);
-  return lnode_get(node);
+  co_iface_t *iface = NULL;
+  CHECK((iface = co_hash_get(ifaces, iface_name, strlen(iface_name))) != NULL, "Failed to get interface %s profile!", iface_name);
+  return iface;
 error:
   return NULL;
 }
@@ -34,12 +34,13 @@
 #define _IFACE_H
 #include <stdbool.h>
 #include <net/if.h>
+#include <netinet/in.h>
 #include "id.h"
 
 #define FREQ_LEN 5 //number of characters in 802.11 frequency designator
 #define MAC_LEN 6
 #define WPA_REPLY_SIZE 2048
-#define IFACES_MAX 32
+#define IFACE_ADDRS_MAX 8
 #define SIOCGIWNAME 0x8B01
 
 typedef enum {
@@ -48,15 +49,31 @@ typedef enum {
 } co_iface_status_t;
 
 typedef struct {
-  int fd;
+  int family;
+  unsigned char prefixlen;
+  union {
+    struct in_addr v4;
+    struct in6_addr v6;
+  } addr;
+} co_iface_addr_t;
+
+typedef struct {
+  int index;
+  unsigned int flags;
+  bool present;
+  bool lost;
   co_iface_status_t status;
   char *profile;
   struct ifreq ifr;
   struct wpa_ctrl *ctrl;
   int wpa_id;
   bool wireless;
+  int naddrs;
+  co_iface_addr_t addrs[IFACE_ADDRS_MAX];
 } co_iface_t;
 
+typedef int (*co_iface_reapply_t)(co_iface_t *iface);
+
 int co_ifaces_create(void);
 
 int co_iface_remove(const char *iface_name);
@@ -103,4 +120,8 @@ char *co_iface_profile(const char *iface_name);
 
 co_iface_t *co_iface_get(const char *iface_name);
 
+int co_iface_monitor(void *sock, co_iface_reapply_t reapply);
+
+int co_iface_monitor_cb(void *self, void *context);
+
 #endif
@@ -278,10 +278,10 @@ int co_loop_add_socket(void *new_sock, void *context) {
     } else {
       SENTINEL("Socket %s already registered.", sock->uri);
     }
-  } else if((sock->listen) && (sock->fd > 0) && !sock->fd_registered) {
+  } else if((sock->fd > 0) && !sock->fd_registered) {
       DEBUG("Adding FD %d to epoll.", sock->fd);
       event.data.fd = sock->fd;
-      CHECK((epoll_ctl(poll_fd, EPOLL_CTL_ADD, sock->fd, &event)) != -1, "Failed to add listen FD epoll event.");
+      CHECK((epoll_ctl(poll_fd, EPOLL_CTL_ADD, sock->fd, &event)) != -1, "Failed to add FD epoll event.");
       sock->fd_registered = true; 
       list_append(sockets, lnode_create((void *)sock));
       return 1;
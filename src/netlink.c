@@ -0,0 +1,134 @@
+/* vim: set ts=2 expandtab: */
+/**
+ *       @file  netlink.c
+ *      @brief  a netlink socket type for tracking kernel interface state
+ *
+ *     @author  Josh King (jheretic), jking@chambana.net
+ *
+ *   @internal
+ *     Created  03/07/2013
+ *    Revision  $Id: doxygen.commotion.templates,v 0.1 2013/01/01 09:00:00 jheretic Exp $
+ *    Compiler  gcc/g++
+ *     Company  The Open Technology Institute
+ *   Copyright  Copyright (c) 2013, Josh King
+ *
+ * This file is part of Commotion, Copyright (c) 2013, Josh King 
+ * 
+ * Commotion is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, 
+ * or (at your option) any later version.
+ * 
+ * Commotion is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Commotion.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include "debug.h"
+#include "socket.h"
+#include "util.h"
+#include "netlink.h"
+
+co_socket_t netlink_socket_proto = {
+  .init = netlink_socket_init,
+  .bind = netlink_socket_bind,
+  .receive = netlink_socket_receive
+};
+
+int netlink_socket_init(void *self) {
+  if(self) {
+    netlink_socket_t *this = self;
+    this->_(fd) = -1;
+    this->_(rfd) = -1;
+    this->_(local) = calloc(1, sizeof(struct sockaddr_nl));
+    this->_(remote) = calloc(1, sizeof(struct sockaddr_nl));
+    this->_(fd_registered) = false;
+    this->_(rfd_registered) = false;
+    this->_(listen) = false;
+    this->_(uri) = strdup("netlink://");
+    this->groups = 0;
+    this->seq = 0;
+    return 1;
+  } else return 0;
+}
+
+int netlink_socket_bind(void *self, const char *endpoint) {
+  DEBUG("Binding netlink_socket %s.", endpoint);
+  netlink_socket_t *this = self;
+  struct sockaddr_nl *address = (struct sockaddr_nl *)this->_(local);
+  CHECK_MEM(address);
+
+  //Only the monitor endpoint subscribes to multicast groups.
+  if(!strcmp(endpoint, NETLINK_MONITOR)) this->groups = NETLINK_MONITOR_GROUPS;
+  address->nl_family = AF_NETLINK;
+  address->nl_groups = this->groups;
+
+  CHECK((this->_(fd) = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE)) != -1, "Failed to grab netlink socket file descriptor.");
+  CHECK(!bind(this->_(fd), (struct sockaddr *) address, sizeof(struct sockaddr_nl)), "Failed to bind netlink socket %s.", endpoint);
+
+  size_t urilen = strlen("netlink://") + strlen(endpoint) + 1;
+  free(this->_(uri));
+  CHECK_MEM(this->_(uri) = malloc(urilen));
+  snprintf(this->_(uri), urilen, "netlink://%s", endpoint);
+
+  if(this->_(register_cb)) this->_(register_cb)(this, NULL);
+  return 1;
+
+error:
+  close(this->_(fd));
+  this->_(fd) = -1;
+  return 0;
+}
+
+int netlink_socket_receive(void *self, char *incoming, size_t length) {
+  CHECK_MEM(self);
+  co_socket_t *this = self;
+  struct sockaddr_nl from;
+  struct iovec iov = { incoming, length };
+  struct msghdr msg = { &from, sizeof(from), &iov, 1, NULL, 0, 0 };
+  int received = recvmsg(this->fd, &msg, MSG_DONTWAIT);
+
+  //Drop anything that didn't come from the kernel.
+  if(received > 0 && from.nl_pid != 0) return 0;
+  return received;
+
+error:
+  return -1;
+}
+
+int co_netlink_request_dump(co_socket_t *sock, const int type, const int family) {
+  CHECK_MEM(sock);
+  netlink_socket_t *this = (netlink_socket_t *)sock;
+  struct {
+    struct nlmsghdr nh;
+    struct rtgenmsg gen;
+  } req;
+  struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+
+  memset(&req, '\0', sizeof(req));
+  req.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg));
+  req.nh.nlmsg_type = type;
+  req.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.nh.nlmsg_seq = ++this->seq;
+  req.gen.rtgen_family = family;
+
+  CHECK(sendto(sock->fd, &req, req.nh.nlmsg_len, 0, (struct sockaddr *)&kernel, sizeof(kernel)) != -1, "Failed to request netlink dump of type %d.", type);
+  return 1;
+
+error:
+  return 0;
+}
@@ -0,0 +1,61 @@
+/* vim: set ts=2 expandtab: */
+/**
+ *       @file  netlink.h
+ *      @brief  a netlink socket type for tracking kernel interface state
+ *
+ *     @author  Josh King (jheretic), jking@chambana.net
+ *
+ *   @internal
+ *     Created  03/07/2013
+ *    Revision  $Id: doxygen.commotion.templates,v 0.1 2013/01/01 09:00:00 jheretic Exp $
+ *    Compiler  gcc/g++
+ *     Company  The Open Technology Institute
+ *   Copyright  Copyright (c) 2013, Josh King
+ *
+ * This file is part of Commotion, Copyright (c) 2013, Josh King 
+ * 
+ * Commotion is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, 
+ * or (at your option) any later version.
+ * 
+ * Commotion is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with Commotion.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * =====================================================================================
+ */
+
+#ifndef _NETLINK_H
+#define _NETLINK_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include "socket.h"
+
+#define NETLINK_BUFSIZE 8192
+#define NETLINK_MONITOR "monitor"
+#define NETLINK_MONITOR_GROUPS (RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR)
+
+typedef struct {
+  co_socket_t proto;
+  uint32_t groups;
+  uint32_t seq;
+} netlink_socket_t;
+
+int netlink_socket_init(void *self);
+
+int netlink_socket_bind(void *self, const char *endpoint);
+
+int netlink_socket_receive(void *self, char *incoming, size_t length);
+
+int co_netlink_request_dump(co_socket_t *sock, const int type, const int family);
+
+#endif